@@ -0,0 +1,193 @@
+#pragma once
+
+// Workspace range calculation and slot resolution shared by the plugin (mapMonitor/unmapMonitor) and the trace replay tool.
+// This header must not depend on Hyprland, so the replay tool can be built without it.
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct MonitorConfigValue {
+    int64_t value = 0;
+    bool wasSetFromConfig = false;
+
+    // favor value in usage
+    operator int64_t() const
+    {
+        return value;
+    }
+    int64_t operator=(int64_t v)
+    {
+        value = v;
+        return value;
+    }
+};
+
+using MonitorConfigMap = std::map<std::string, MonitorConfigValue>;
+
+// avoid default initialization with []
+inline int64_t getMonitorMaxWorkspaces(const MonitorConfigMap& maxWorkspaces, int64_t defaultCount, const std::string& name)
+{
+    auto const it = maxWorkspaces.find(name);
+    return it != maxWorkspaces.end() ? it->second : defaultCount;
+}
+
+inline int64_t calcWorkspaceBaseIndex(const MonitorConfigMap& priorities, const MonitorConfigMap& maxWorkspaces, int64_t defaultCount, const std::string& name)
+{
+    auto const it = priorities.find(name);
+    int64_t currentPriority = it != priorities.end() ? it->second.value : 0;
+
+    int64_t offset = 0;
+    for (const auto& [n, p] : priorities) {
+        if (p < currentPriority) {
+            offset += getMonitorMaxWorkspaces(maxWorkspaces, defaultCount, n);
+        }
+    }
+
+    return offset;
+}
+
+// determine monitor priority if not set: monitors without a configured priority are ordered by when they were first mapped
+inline void ensureMonitorPriority(MonitorConfigMap& priorities, const std::string& name)
+{
+    if (!priorities.contains(name)) {
+        priorities[name] = static_cast<int64_t>(priorities.size());
+    }
+}
+
+// forget the values that were derived while mapping, so they get recalculated if the monitor comes back
+inline void releaseMonitorConfig(MonitorConfigMap& priorities, MonitorConfigMap& maxWorkspaces, const std::string& name)
+{
+    if (priorities.contains(name) && !priorities[name].wasSetFromConfig) {
+        priorities.erase(name);
+    }
+
+    if (maxWorkspaces.contains(name) && !maxWorkspaces[name].wasSetFromConfig) {
+        maxWorkspaces.erase(name);
+    }
+}
+
+// the names of the workspaces mapped to a monitor, in slot order. The first slot has the workspace ID base + 1.
+inline std::vector<std::string> getMonitorWorkspaceNames(const MonitorConfigMap& priorities, const MonitorConfigMap& maxWorkspaces, int64_t defaultCount, const std::string& name)
+{
+    int64_t const workspaceIndex = calcWorkspaceBaseIndex(priorities, maxWorkspaces, defaultCount, name) + 1;
+    int64_t const maxCount = getMonitorMaxWorkspaces(maxWorkspaces, defaultCount, name);
+
+    std::vector<std::string> names;
+    names.reserve(maxCount > 0 ? maxCount : 0);
+    for (int64_t i = workspaceIndex; i < workspaceIndex + maxCount; i++) {
+        names.push_back(std::to_string(i));
+    }
+    return names;
+}
+
+// a per-monitor slot, parsed from one of:
+// #1 - "empty" -> the first empty workspace on the monitor, or the last workspace if all have windows
+// #2 - "+1", "-2" -> relative to the active workspace
+// #3 - "1", "2", "3" -> absolute slot, 1-indexed
+struct WorkspaceSlot {
+    enum eType : uint8_t {
+        ABSOLUTE,
+        RELATIVE,
+        EMPTY,
+    };
+
+    eType type = ABSOLUTE;
+    int value = 0; // ABSOLUTE: 0-indexed slot, RELATIVE: delta
+};
+
+// returns false and sets error if the string is not a slot (e.g. a named workspace).
+// Like std::stoi, a number that doesn't fit an int throws std::out_of_range.
+inline bool parseWorkspaceSlot(const std::string& workspace, WorkspaceSlot& slot, std::string& error)
+{
+    if (workspace == "empty") {
+        slot = {.type = WorkspaceSlot::EMPTY};
+        return true;
+    }
+
+    if (workspace.starts_with("+") || workspace.starts_with("-")) {
+        int delta = 0;
+        try {
+            delta = std::stoi(workspace);
+        }
+        catch (const std::invalid_argument&) {
+        }
+        if (delta == 0) {
+            error = "invalid workspace delta";
+            return false;
+        }
+        slot = {.type = WorkspaceSlot::RELATIVE, .value = delta};
+        return true;
+    }
+
+    try {
+        // convert to 0-indexed int
+        slot = {.type = WorkspaceSlot::ABSOLUTE, .value = std::stoi(workspace) - 1};
+    }
+    catch (const std::invalid_argument&) {
+        error = "invalid workspace index";
+        return false;
+    }
+    return true;
+}
+
+// Resolves a parsed slot to one of the monitor's workspace names, or returns nullptr and sets error.
+// isEmpty(name) tells whether a workspace has no windows, for WorkspaceSlot::EMPTY.
+template <typename IsEmptyFn>
+const std::string* resolveWorkspaceSlot(const std::vector<std::string>& workspaces, const std::string& activeWorkspace, const WorkspaceSlot& slot, bool wrapping, IsEmptyFn&& isEmpty,
+                                        std::string& error)
+{
+    if (workspaces.empty()) {
+        error = "no workspaces mapped";
+        return nullptr;
+    }
+
+    int64_t workspaceIndex = slot.value;
+    switch (slot.type) {
+        case WorkspaceSlot::EMPTY: {
+            // we expect the new ID to be the first available ID on the given monitor (not the first ID in the global list)
+            auto const it = std::ranges::find_if(workspaces, isEmpty);
+            // if no empty workspace, we just go to the last workspace in the map
+            return it != workspaces.end() ? &*it : &workspaces.back();
+        }
+        case WorkspaceSlot::RELATIVE: {
+            // find the current workspace index in the monitor's workspace list
+            auto const it = std::ranges::find(workspaces, activeWorkspace);
+            if (it == workspaces.end()) {
+                error = "current workspace " + activeWorkspace + " not found in monitor workspaces";
+                return nullptr;
+            }
+            workspaceIndex = std::distance(workspaces.begin(), it) + slot.value;
+            break;
+        }
+        case WorkspaceSlot::ABSOLUTE: break;
+    }
+
+    if (workspaceIndex < 0) {
+        return wrapping ? &workspaces.back() : &workspaces.front(); // wrap around to the last workspace, or stop at the first
+    }
+
+    if (static_cast<size_t>(workspaceIndex) >= workspaces.size()) {
+        return wrapping ? &workspaces.front() : &workspaces.back(); // wrap around to the first workspace, or stop at the last
+    }
+
+    return &workspaces[workspaceIndex];
+}
+
+// Same for a slot string, as passed to the dispatchers. If it can't be resolved, the input is returned as is (e.g. a named workspace)
+// and error describes why. Like std::stoi, a number that doesn't fit an int throws std::out_of_range.
+template <typename IsEmptyFn>
+const std::string& resolveWorkspaceSlot(const std::vector<std::string>& workspaces, const std::string& activeWorkspace, const std::string& workspace, bool wrapping, IsEmptyFn&& isEmpty,
+                                        std::string& error)
+{
+    WorkspaceSlot slot;
+    if (!parseWorkspaceSlot(workspace, slot, error)) {
+        // if parsing fails, assume the user wants a workspace by name
+        return workspace;
+    }
+    const std::string* result = resolveWorkspaceSlot(workspaces, activeWorkspace, slot, wrapping, isEmpty, error);
+    return result != nullptr ? *result : workspace;
+}
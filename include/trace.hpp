@@ -0,0 +1,259 @@
+#pragma once
+
+// Compact binary trace of the events the plugin reacts to (split-* dispatchers, monitor hotplug, config reloads).
+// Written by the plugin when trace_file is set, and read by the replay tool in tools/replay.cpp.
+// This header must not depend on Hyprland, so the replay tool can be built without it.
+//
+// Layout (integers in host byte order, strings as u16 length + bytes):
+//   header:  "SMWT" u16 version
+//   event:   u8 type, u64 nanoseconds since the recording started, then per type:
+//     DISPATCH:        string dispatcher, string argument
+//     MONITOR_ADDED:   i64 monitor ID, string name, u8 skipped (disabled or mirrored)
+//     MONITOR_REMOVED: i64 monitor ID, string name, u8 skipped
+//     CONFIG_RELOAD:   i64 count, u8 flags, string default monitor, u16 n + n * (string name, i64 priority), u16 n + n * (string name, i64 max workspaces),
+//                      u16 n + n * (i64 monitor ID, string name, u8 skipped)
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Trace {
+
+constexpr std::array<char, 4> MAGIC = {'S', 'M', 'W', 'T'};
+constexpr uint16_t VERSION = 2;
+
+enum class eEventType : uint8_t {
+    DISPATCH = 0,
+    MONITOR_ADDED = 1,
+    MONITOR_REMOVED = 2,
+    CONFIG_RELOAD = 3,
+};
+
+enum eConfigFlags : uint8_t {
+    CONFIG_PERSISTENT = 1 << 0,
+    CONFIG_WRAPPING = 1 << 1,
+    CONFIG_KEEP_FOCUSED = 1 << 2,
+    CONFIG_LINK_MONITORS = 1 << 3,
+};
+
+struct SMonitor {
+    int64_t id = 0;
+    std::string name;
+    bool skipped = false;
+};
+
+struct SConfig {
+    int64_t workspaceCount = 0;
+    uint8_t flags = 0;
+    std::string defaultMonitor; // cursor:default_monitor, used to pick the primary monitor
+    std::vector<std::pair<std::string, int64_t>> priorities;
+    std::vector<std::pair<std::string, int64_t>> maxWorkspaces;
+    // the monitors present when the config was reloaded, in the order they were remapped
+    std::vector<SMonitor> monitors;
+};
+
+struct SEvent {
+    eEventType type = eEventType::DISPATCH;
+    uint64_t timestampNs = 0;
+
+    // DISPATCH
+    std::string dispatcher;
+    std::string argument;
+
+    // MONITOR_ADDED, MONITOR_REMOVED
+    SMonitor monitor;
+
+    // CONFIG_RELOAD
+    SConfig config;
+};
+
+class CWriter {
+  public:
+    bool open(const std::string& path)
+    {
+        m_file.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_file.good()) {
+            return false;
+        }
+        m_file.write(MAGIC.data(), MAGIC.size());
+        writeInt(VERSION);
+        return m_file.good();
+    }
+
+    void close()
+    {
+        m_file.close();
+    }
+
+    bool isOpen() const
+    {
+        return m_file.is_open();
+    }
+
+    void write(const SEvent& event)
+    {
+        writeInt(static_cast<uint8_t>(event.type));
+        writeInt(event.timestampNs);
+        switch (event.type) {
+            case eEventType::DISPATCH:
+                writeString(event.dispatcher);
+                writeString(event.argument);
+                break;
+            case eEventType::MONITOR_ADDED:
+            case eEventType::MONITOR_REMOVED: writeMonitor(event.monitor); break;
+            case eEventType::CONFIG_RELOAD:
+                writeInt(event.config.workspaceCount);
+                writeInt(event.config.flags);
+                writeString(event.config.defaultMonitor);
+                writePairs(event.config.priorities);
+                writePairs(event.config.maxWorkspaces);
+                writeInt(static_cast<uint16_t>(event.config.monitors.size()));
+                for (const auto& monitor : event.config.monitors) {
+                    writeMonitor(monitor);
+                }
+                break;
+        }
+        // flush every event, the compositor may go down with the bug we are trying to record
+        m_file.flush();
+    }
+
+  private:
+    template <typename T> void writeInt(T value)
+    {
+        m_file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(const std::string& value)
+    {
+        auto const length = static_cast<uint16_t>(std::min<size_t>(value.size(), UINT16_MAX));
+        writeInt(length);
+        m_file.write(value.data(), length);
+    }
+
+    void writeMonitor(const SMonitor& monitor)
+    {
+        writeInt(monitor.id);
+        writeString(monitor.name);
+        writeInt(static_cast<uint8_t>(monitor.skipped));
+    }
+
+    void writePairs(const std::vector<std::pair<std::string, int64_t>>& pairs)
+    {
+        writeInt(static_cast<uint16_t>(pairs.size()));
+        for (const auto& [name, value] : pairs) {
+            writeString(name);
+            writeInt(value);
+        }
+    }
+
+    std::ofstream m_file;
+};
+
+class CReader {
+  public:
+    // returns false if the file can't be opened or is not a trace of a supported version
+    bool open(const std::string& path)
+    {
+        m_file.open(path, std::ios::binary);
+        std::array<char, 4> magic{};
+        m_file.read(magic.data(), magic.size());
+        uint16_t version = 0;
+        return m_file.good() && magic == MAGIC && readInt(version) && version == VERSION;
+    }
+
+    // returns false at the end of the trace, or if the next event can't be read. failed() tells the two apart
+    bool next(SEvent& event)
+    {
+        event = SEvent{};
+        if (m_file.peek() == std::ifstream::traits_type::eof()) {
+            return false; // clean end of the trace, the last event was complete
+        }
+        m_failed = !readEvent(event);
+        return !m_failed;
+    }
+
+    // whether reading stopped at a truncated event or an unknown event type, i.e. the trace is damaged
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+  private:
+    bool readEvent(SEvent& event)
+    {
+        uint8_t type = 0;
+        if (!readInt(type) || !readInt(event.timestampNs)) {
+            return false;
+        }
+        event.type = static_cast<eEventType>(type);
+        switch (event.type) {
+            case eEventType::DISPATCH: return readString(event.dispatcher) && readString(event.argument);
+            case eEventType::MONITOR_ADDED:
+            case eEventType::MONITOR_REMOVED: return readMonitor(event.monitor);
+            case eEventType::CONFIG_RELOAD: {
+                uint16_t monitorCount = 0;
+                if (!readInt(event.config.workspaceCount) || !readInt(event.config.flags) || !readString(event.config.defaultMonitor) || !readPairs(event.config.priorities) ||
+                    !readPairs(event.config.maxWorkspaces) || !readInt(monitorCount)) {
+                    return false;
+                }
+                event.config.monitors.resize(monitorCount);
+                for (auto& monitor : event.config.monitors) {
+                    if (!readMonitor(monitor)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+        return false; // unknown event type
+    }
+
+    template <typename T> bool readInt(T& value)
+    {
+        return static_cast<bool>(m_file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool readString(std::string& value)
+    {
+        uint16_t length = 0;
+        if (!readInt(length)) {
+            return false;
+        }
+        value.resize(length);
+        return static_cast<bool>(m_file.read(value.data(), length));
+    }
+
+    bool readMonitor(SMonitor& monitor)
+    {
+        uint8_t skipped = 0;
+        if (!readInt(monitor.id) || !readString(monitor.name) || !readInt(skipped)) {
+            return false;
+        }
+        monitor.skipped = skipped != 0;
+        return true;
+    }
+
+    bool readPairs(std::vector<std::pair<std::string, int64_t>>& pairs)
+    {
+        uint16_t count = 0;
+        if (!readInt(count)) {
+            return false;
+        }
+        pairs.resize(count);
+        for (auto& [name, value] : pairs) {
+            if (!readString(name) || !readInt(value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::ifstream m_file;
+    bool m_failed = false;
+};
+
+} // namespace Trace
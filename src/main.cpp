@@ -11,9 +11,15 @@
 #include <hyprutils/memory/SharedPtr.hpp>
 
 #include "globals.hpp"
+#include "mapping.hpp"
+#include "trace.hpp"
 
+#include <chrono>
+#include <format>
 #include <map>
+#include <regex>
 #include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
 auto constexpr k_workspaceCount = "plugin:split-monitor-workspaces:count";
@@ -25,6 +31,8 @@ auto constexpr k_defaultMonitor = "cursor:default_monitor";
 auto constexpr k_monitorPriority = "plugin:split-monitor-workspaces:monitor_priority";
 auto constexpr k_monitorMaxWorkspaces = "plugin:split-monitor-workspaces:max_workspaces";
 auto constexpr k_linkMonitors = "plugin:split-monitor-workspaces:link_monitors";
+auto constexpr k_traceFile = "plugin:split-monitor-workspaces:trace_file";
+auto constexpr k_windowSlot = "plugin:split-monitor-workspaces:window_slot";
 
 static const CHyprColor s_pluginColor = {0x61 / 255.0F, 0xAF / 255.0F, 0xEF / 255.0F, 1.0F};
 
@@ -35,36 +43,39 @@ static bool g_enablePersistentWorkspaces = true;
 static bool g_enableWrapping = true;
 static std::string g_defaultMonitor = "";
 static bool g_linkMonitors = false;
+static std::string g_traceFile = "";
 
 // the first time we load the plugin, we want to switch to the first workspace on the primary monitor regardless of keepFocused
 static bool g_firstLoad = true;
 
-static std::map<MONITORID, std::vector<std::string>> g_vMonitorWorkspaceMap;
-static std::vector<PHLWORKSPACE> g_vPersistentWorkspaces; // to keep ownership of persistent workspaces, otherwise Hyprland will remove them
-
-struct MonitorConfigValue {
-    int64_t value = 0;
-    bool wasSetFromConfig = false;
+static Trace::CWriter g_traceWriter;
+static std::chrono::steady_clock::time_point g_traceStart;
 
-    // favor value in usage
-    operator int64_t() const
-    {
-        return value;
-    }
-    int64_t operator=(int64_t v)
-    {
-        value = v;
-        return value;
-    }
+static std::map<MONITORID, std::vector<std::string>> g_vMonitorWorkspaceMap;
+// to keep ownership of persistent workspaces, otherwise Hyprland will remove them.
+// keyed by workspace ID so pinning the same workspace twice (e.g. on monitor hotplug) is a no-op and releasing is O(1)
+static std::unordered_map<WORKSPACEID, PHLWORKSPACE> g_vPersistentWorkspaces;
+
+static MonitorConfigMap g_vMonitorPriorities;
+static MonitorConfigMap g_vMonitorMaxWorkspaces;
+
+// parsed once when the config is loaded, only matched and resolved when a window opens
+struct WindowSlotRule {
+    std::regex matcher;
+    bool matchTitle = false; // match the initial title instead of the initial class
+    std::string monitorName; // empty => the monitor the window opens on
+    WorkspaceSlot slot;      // parsed from e.g. "3", "+1" or "empty"
 };
 
-static std::map<std::string, MonitorConfigValue> g_vMonitorPriorities;
-static std::map<std::string, MonitorConfigValue> g_vMonitorMaxWorkspaces;
+static std::vector<WindowSlotRule> g_vWindowSlotRules;
 
 static SP<HOOK_CALLBACK_FN> e_monitorAddedHandle = nullptr;
 static SP<HOOK_CALLBACK_FN> e_monitorRemovedHandle = nullptr;
 static SP<HOOK_CALLBACK_FN> e_configReloadedHandle = nullptr;
 static SP<HOOK_CALLBACK_FN> e_preConfigReloadHandle = nullptr;
+static SP<HOOK_CALLBACK_FN> e_openWindowEarlyHandle = nullptr;
+
+static SP<SHyprCtlCommand> e_pinnedCommandHandle = nullptr;
 
 static void raiseNotification(const std::string& message, float timeout = 5000.0F)
 {
@@ -73,10 +84,9 @@ static void raiseNotification(const std::string& message, float timeout = 5000.0
     }
 }
 
-// avoid default initialization with []
-int64_t getMonitorMaxWorkspaces(const std::string& name)
+static int64_t getMonitorMaxWorkspaces(const std::string& name)
 {
-    return g_vMonitorMaxWorkspaces.contains(name) ? g_vMonitorMaxWorkspaces[name] : g_workspaceCount;
+    return getMonitorMaxWorkspaces(g_vMonitorMaxWorkspaces, g_workspaceCount, name);
 }
 
 static int getDelta(const std::string& direction)
@@ -154,9 +164,21 @@ static PHLMONITOR getPrimaryMonitor()
     throw std::runtime_error("split-monitor-workspaces: No valid monitors found?");
 }
 
+// the workspace is either not yet created (=nullptr) or already created but empty (!= nullptr but no windows).
+// ignoredWindow doesn't count, e.g. a window that is being opened and is already mapped on its initial workspace
+static bool isWorkspaceEmpty(const std::string& workspaceName, const PHLWINDOW& ignoredWindow = nullptr)
+{
+    PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByName(workspaceName);
+    if (workspace == nullptr) {
+        return true;
+    }
+    const bool countsIgnored = ignoredWindow != nullptr && ignoredWindow->m_isMapped && ignoredWindow->m_workspace == workspace;
+    return workspace->getWindows() - (countsIgnored ? 1 : 0) == 0;
+}
+
 static const std::string& getWorkspaceFromMonitor(const PHLMONITOR& monitor, const std::string& workspace)
 {
-    // based on the string, we parse multiple formats:
+    // based on the string, we parse multiple formats (see WorkspaceSlot):
     // #1 - "empty" -> get the first empty workspace on the monitor, or the last workspace if all have windows
     // #2 - "+1", "-2" -> relative workspace ID, e.g. next or previous workspace
     // #3 - "1", "2", "3" -> absolute workspace ID, e.g. workspace 1, 2 or 3 on the current monitor
@@ -173,64 +195,31 @@ static const std::string& getWorkspaceFromMonitor(const PHLMONITOR& monitor, con
         return workspace; // use the original string if no workspaces are mapped
     }
 
-    // #1 if the workspace is "empty", we expect the new ID to be the first available ID on the given monitor (not the first ID in the global list)
-    if (workspace == "empty") {
-        // get the next workspace ID that is empty on this monitor
-        for (const auto& workspaceName : curWorkspaces) {
-            PHLWORKSPACE workspacePtr = g_pCompositor->getWorkspaceByName(workspaceName);
-            // the workspace we want is either not yet created (=nullptr) or already created but empty (!= nullptr but no windows)
-            if (workspacePtr == nullptr || workspacePtr->getWindows() == 0) {
-                return workspaceName;
-            }
-        }
-        // if no empty monitor, we just go to the last workspace in the map
-        return curWorkspaces.back();
-    }
+    auto const isEmpty = [](const std::string& workspaceName) { return isWorkspaceEmpty(workspaceName); };
+    const std::string activeWorkspace = monitor->m_activeWorkspace != nullptr ? monitor->m_activeWorkspace->m_name : "";
 
-    int workspaceIndex = 0;
-    if (workspace.starts_with("+") || workspace.starts_with("-")) {
-        // #2 relative IDS, e.g. +1, -2
-        auto delta = getDelta(workspace);
-        if (delta == 0) {
-            Log::logger->log(Log::ERR, "[split-monitor-workspaces] Invalid workspace delta: {}", workspace.c_str());
-            return workspace;
-        }
-        // find the current workspace index in the monitor's workspace list
-        auto it = std::ranges::find(curWorkspaces, monitor->m_activeWorkspace->m_name);
-        if (it == curWorkspaces.end()) {
-            Log::logger->log(Log::ERR, "[split-monitor-workspaces] Current workspace {} not found in monitor workspaces", monitor->m_activeWorkspace->m_name.c_str());
-            return workspace;
-        }
-        workspaceIndex = std::distance(curWorkspaces.begin(), it) + delta;
-    }
-    else {
-        // #3 absolute IDs, e.g. 1, 2, 3
-        try {
-            // convert to 0-indexed int
-            workspaceIndex = std::stoi(workspace) - 1;
-        }
-        catch (std::invalid_argument&) {
-            // if parsing fails, assume the user wants to switch to the workspace by name
-            Log::logger->log(Log::WARN, "[split-monitor-workspaces] Invalid workspace index: {}, assuming named workspace", workspace.c_str());
-            return workspace;
-        }
-    }
-
-    if (workspaceIndex < 0) {
-        if (g_enableWrapping) {
-            return curWorkspaces.back(); // wrap around to the last workspace
-        }
-        return curWorkspaces.front(); // stop at the first workspace
+    std::string error;
+    const std::string& result = resolveWorkspaceSlot(curWorkspaces, activeWorkspace, workspace, g_enableWrapping, isEmpty, error);
+    if (!error.empty()) {
+        Log::logger->log(Log::WARN, "[split-monitor-workspaces] Workspace {}: {}", workspace.c_str(), error.c_str());
     }
+    return result;
+}
 
-    if ((size_t)workspaceIndex >= curWorkspaces.size()) {
-        if (g_enableWrapping) {
-            return curWorkspaces.front(); // wrap around to the first workspace
-        }
-        return curWorkspaces.back(); // stop at the last workspace
+// Resolves a slot to one of the workspaces mapped to the monitor, or returns nullptr and sets error. Unlike getWorkspaceFromMonitor, a slot
+// that can't be resolved is not passed on as a workspace name, that would be a global workspace which may belong to another monitor.
+// ignoredWindow is left out of the "empty" check (see isWorkspaceEmpty)
+static const std::string* getMappedWorkspaceName(const PHLMONITOR& monitor, const WorkspaceSlot& slot, std::string& error, const PHLWINDOW& ignoredWindow = nullptr)
+{
+    auto const curWorkspacesIt = g_vMonitorWorkspaceMap.find(monitor->m_id);
+    if (curWorkspacesIt == g_vMonitorWorkspaceMap.end()) {
+        error = "monitor " + monitor->m_name + " is not mapped";
+        return nullptr;
     }
 
-    return curWorkspaces[workspaceIndex];
+    auto const isEmpty = [&ignoredWindow](const std::string& workspaceName) { return isWorkspaceEmpty(workspaceName, ignoredWindow); };
+    const std::string activeWorkspace = monitor->m_activeWorkspace != nullptr ? monitor->m_activeWorkspace->m_name : "";
+    return resolveWorkspaceSlot(curWorkspacesIt->second, activeWorkspace, slot, g_enableWrapping, isEmpty, error);
 }
 
 static PHLMONITOR getCurrentMonitor()
@@ -334,6 +323,133 @@ static SDispatchResult splitMoveToWorkspaceSilent(const std::string& workspace)
     return {.success = result == "ok", .error = result};
 }
 
+// parses a slot given to a dispatcher, fails instead of falling back to a named workspace
+static bool parseSlotArgument(const std::string& value, WorkspaceSlot& slot, std::string& error)
+{
+    try {
+        if (parseWorkspaceSlot(value, slot, error)) {
+            return true;
+        }
+        error = "Invalid slot " + value + ": " + error;
+    }
+    catch (const std::out_of_range&) {
+        error = "Slot out of range: " + value;
+    }
+    return false;
+}
+
+static PHLWORKSPACE getOrCreateMappedWorkspace(const PHLMONITOR& monitor, const WorkspaceSlot& slot, std::string& error, const PHLWINDOW& ignoredWindow = nullptr)
+{
+    const std::string* workspaceName = getMappedWorkspaceName(monitor, slot, error, ignoredWindow);
+    if (workspaceName == nullptr) {
+        return nullptr;
+    }
+    PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByName(*workspaceName);
+    if (workspace == nullptr) {
+        // not created yet (e.g. persistent workspaces are disabled), create it on the monitor it is mapped to. Mapped names are always numeric
+        Log::logger->log(Log::INFO, "[split-monitor-workspaces] Creating workspace {}", *workspaceName);
+        workspace = g_pCompositor->createNewWorkspace(std::stoll(*workspaceName), monitor->m_id);
+    }
+    return workspace;
+}
+
+static PHLWORKSPACE resolveTargetWorkspace(const std::string& target, std::string& error)
+{
+    // the target is either a slot on the current monitor ("3", "+1", "empty") or a slot on a given monitor ("DP-2:3")
+    PHLMONITOR monitor = getCurrentMonitor();
+    std::string slot = target;
+    if (auto const separator = target.find(':'); separator != std::string::npos) {
+        const std::string monitorName = target.substr(0, separator);
+        monitor = g_pCompositor->getMonitorFromName(monitorName);
+        if (monitor == nullptr) {
+            error = "Monitor not found: " + monitorName;
+            Log::logger->log(Log::WARN, "[split-monitor-workspaces] Monitor '{}' for target {} is not connected", monitorName.c_str(), target.c_str());
+            return nullptr;
+        }
+        slot = target.substr(separator + 1);
+    }
+    WorkspaceSlot parsedSlot;
+    if (!parseSlotArgument(slot, parsedSlot, error)) {
+        return nullptr;
+    }
+    PHLWORKSPACE workspace = getOrCreateMappedWorkspace(monitor, parsedSlot, error);
+    if (workspace == nullptr) {
+        error = "Invalid target workspace " + target + ": " + error;
+    }
+    return workspace;
+}
+
+static SDispatchResult moveWorkspaceWindows(const PHLWORKSPACE& sourceWorkspace, const std::string& target)
+{
+    if (sourceWorkspace == nullptr) {
+        // the slot's workspace was never created (e.g. persistent workspaces are disabled), so there is nothing to move
+        return {.success = true, .error = ""};
+    }
+    std::string error;
+    const PHLWORKSPACE targetWorkspace = resolveTargetWorkspace(target, error);
+    if (targetWorkspace == nullptr) {
+        Log::logger->log(Log::WARN, "[split-monitor-workspaces] {}", error.c_str());
+        return {.success = false, .error = error};
+    }
+    if (targetWorkspace == sourceWorkspace) {
+        return {.success = true, .error = ""}; // nothing to move
+    }
+
+    // collect the windows first, moving them while iterating would change what the workspace reports.
+    // pinned windows are shown on every workspace, so they stay where they are
+    std::vector<PHLWINDOW> windows;
+    windows.reserve(sourceWorkspace->getWindows());
+    for (const auto& window : g_pCompositor->m_windows) {
+        if (window->m_isMapped && !window->m_pinned && window->m_workspace == sourceWorkspace) {
+            windows.push_back(window);
+        }
+    }
+
+    Log::logger->log(Log::INFO, "[split-monitor-workspaces] Moving {} windows from workspace {} to workspace {}", windows.size(), sourceWorkspace->m_name.c_str(),
+                     targetWorkspace->m_name.c_str());
+    // move directly through the compositor instead of one movetoworkspacesilent dispatch per window,
+    // so the target is resolved once and neither focus nor the active workspace change in between
+    for (const auto& window : windows) {
+        // moving a window of a group moves the whole group, so the other members may already be there
+        if (window->m_workspace != targetWorkspace) {
+            g_pCompositor->moveWindowToWorkspaceSafe(window, targetWorkspace);
+        }
+    }
+    return {.success = true, .error = ""};
+}
+
+static SDispatchResult splitMoveWorkspaceWindows(const std::string& target)
+{
+    const auto currentMonitor = getCurrentMonitor();
+    if (currentMonitor == nullptr) {
+        Log::logger->log(Log::ERR, "[split-monitor-workspaces] No active monitor found");
+        return {.success = false, .error = "No active monitor found"};
+    }
+    return moveWorkspaceWindows(currentMonitor->m_activeWorkspace, target);
+}
+
+static SDispatchResult splitMoveSlotWindows(const std::string& args)
+{
+    const auto ARGS = CVarList(args);
+    if (ARGS.size() != 2) {
+        Log::logger->log(Log::WARN, "[split-monitor-workspaces] Invalid number of arguments, expected 2 (slot, target)");
+        return {.success = false, .error = "Invalid number of arguments, expected 2 (slot, target)"};
+    }
+    const auto currentMonitor = getCurrentMonitor();
+    if (currentMonitor == nullptr) {
+        Log::logger->log(Log::ERR, "[split-monitor-workspaces] No active monitor found");
+        return {.success = false, .error = "No active monitor found"};
+    }
+    WorkspaceSlot slot;
+    std::string error;
+    const std::string* sourceName = parseSlotArgument(ARGS[0], slot, error) ? getMappedWorkspaceName(currentMonitor, slot, error) : nullptr;
+    if (sourceName == nullptr) {
+        Log::logger->log(Log::WARN, "[split-monitor-workspaces] Invalid source slot {}: {}", ARGS[0].c_str(), error.c_str());
+        return {.success = false, .error = "Invalid source slot " + ARGS[0] + ": " + error};
+    }
+    return moveWorkspaceWindows(g_pCompositor->getWorkspaceByName(*sourceName), ARGS[1]);
+}
+
 static SDispatchResult changeMonitor(bool quiet, const std::string& value)
 {
     PHLMONITOR monitor = getCurrentMonitor();
@@ -422,18 +538,68 @@ static SDispatchResult grabRogueWindows(const std::string& /*unused*/)
     return {.success = true, .error = ""};
 }
 
-static int64_t calcWorkspaceBaseIndex(const std::string& name)
+static void pinWorkspace(const PHLWORKSPACE& workspace)
+{
+    workspace->setPersistent(true);
+    // keep a reference to avoid it being destructed (see https://github.com/hyprwm/Hyprland/discussions/11400#discussioncomment-14085672)
+    // try_emplace leaves an existing entry untouched, so re-pinning an already owned workspace doesn't add anything
+    g_vPersistentWorkspaces.try_emplace(workspace->m_id, workspace);
+}
+
+static void unpinWorkspace(const PHLWORKSPACE& workspace)
 {
-    int64_t currentPriority = g_vMonitorPriorities[name];
+    workspace->setPersistent(false);
+    // drop our reference, so it can be destructed if no other references exist
+    g_vPersistentWorkspaces.erase(workspace->m_id);
+}
+
+static std::string pinnedWorkspacesCommand(eHyprCtlOutputFormat format, std::string /*unused*/) // NOLINT(performance-unnecessary-value-param)
+{
+    // rough estimate of what the plugin itself holds on to: one hash node per pinned workspace plus the bucket array,
+    // and the workspace names in the monitor map. The workspaces themselves are owned by Hyprland and not counted.
+    constexpr size_t nodeSize = sizeof(void*) + sizeof(size_t) + sizeof(std::pair<const WORKSPACEID, PHLWORKSPACE>);
+    const size_t registryBytes = (g_vPersistentWorkspaces.size() * nodeSize) + (g_vPersistentWorkspaces.bucket_count() * sizeof(void*));
+
+    size_t mappedCount = 0;
+    size_t mapBytes = 0;
+    for (const auto& [monitorID, workspaces] : g_vMonitorWorkspaceMap) {
+        mappedCount += workspaces.size();
+        mapBytes += workspaces.capacity() * sizeof(std::string);
+        for (const auto& workspaceName : workspaces) {
+            // names longer than the small string buffer live on the heap
+            if (workspaceName.capacity() > std::string{}.capacity()) {
+                mapBytes += workspaceName.capacity() + 1;
+            }
+        }
+    }
 
-    int64_t offset = 0;
-    for (const auto& [n, p] : g_vMonitorPriorities) {
-        if (p < currentPriority) {
-            offset += getMonitorMaxWorkspaces(n);
+    std::map<MONITORID, size_t> pinnedPerMonitor;
+    for (const auto& [workspaceID, workspace] : g_vPersistentWorkspaces) {
+        pinnedPerMonitor[workspace->monitorID()]++;
+    }
+
+    std::string result;
+    if (format == eHyprCtlOutputFormat::FORMAT_JSON) {
+        result += std::format(R"({{"pinned": {}, "mapped": {}, "registryBytes": {}, "mapBytes": {}, "monitors": [)", g_vPersistentWorkspaces.size(), mappedCount, registryBytes, mapBytes);
+        bool first = true;
+        for (const auto& [monitorID, count] : pinnedPerMonitor) {
+            result += std::format(R"({}{{"id": {}, "pinned": {}}})", first ? "" : ", ", monitorID, count);
+            first = false;
         }
+        result += "]}";
+        return result;
+    }
+
+    result += std::format("pinned: {}\nmapped: {}\nregistry bytes (est.): {}\nmap bytes (est.): {}\n", g_vPersistentWorkspaces.size(), mappedCount, registryBytes, mapBytes);
+    for (const auto& [monitorID, count] : pinnedPerMonitor) {
+        result += std::format("monitor {}: {} pinned\n", monitorID, count);
     }
+    return result;
+}
 
-    return offset;
+static int64_t calcWorkspaceBaseIndex(const std::string& name)
+{
+    return calcWorkspaceBaseIndex(g_vMonitorPriorities, g_vMonitorMaxWorkspaces, g_workspaceCount, name);
 }
 
 static void mapMonitor(const PHLMONITOR& monitor) // NOLINT(readability-convert-member-functions-to-static)
@@ -448,10 +614,7 @@ static void mapMonitor(const PHLMONITOR& monitor) // NOLINT(readability-convert-
         return;
     }
 
-    // determine monitor priority if not set
-    if (!g_vMonitorPriorities.contains(monitor->m_name)) {
-        g_vMonitorPriorities[monitor->m_name] = static_cast<int64_t>(g_vMonitorPriorities.size());
-    }
+    ensureMonitorPriority(g_vMonitorPriorities, monitor->m_name);
 
     int64_t workspaceIndex = calcWorkspaceBaseIndex(monitor->m_name);
     int64_t maxWorkspaces = getMonitorMaxWorkspaces(monitor->m_name);
@@ -460,9 +623,26 @@ static void mapMonitor(const PHLMONITOR& monitor) // NOLINT(readability-convert-
     Log::logger->log(Log::INFO, "{}",
                      "[split-monitor-workspaces] Mapping workspaces " + std::to_string(workspaceIndex) + "-" + std::to_string(workspaceIndex + maxWorkspaces - 1) + " to monitor " + monitor->m_name);
 
+    std::vector<std::string> newWorkspaceNames = getMonitorWorkspaceNames(g_vMonitorPriorities, g_vMonitorMaxWorkspaces, g_workspaceCount, monitor->m_name);
+
+    // the monitor may be re-added (e.g. through monitorAddedCallback) without having been unmapped first. Its range may have shifted since,
+    // so release the previously pinned workspaces that are out of the new range. The ones still in range stay pinned, as unpinning them
+    // would destroy the empty ones only for them to be created again below
+    if (auto const previousIt = g_vMonitorWorkspaceMap.find(monitor->m_id); previousIt != g_vMonitorWorkspaceMap.end()) {
+        for (const auto& workspaceName : previousIt->second) {
+            if (std::ranges::find(newWorkspaceNames, workspaceName) != newWorkspaceNames.end()) {
+                continue;
+            }
+            if (PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByName(workspaceName)) {
+                unpinWorkspace(workspace);
+            }
+        }
+    }
+
+    const std::vector<std::string>& workspaceNames = g_vMonitorWorkspaceMap[monitor->m_id] = std::move(newWorkspaceNames);
+
     for (int i = workspaceIndex; i < workspaceIndex + maxWorkspaces; i++) {
-        std::string workspaceName = std::to_string(i);
-        g_vMonitorWorkspaceMap[monitor->m_id].push_back(workspaceName);
+        const std::string& workspaceName = workspaceNames[i - workspaceIndex];
         PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByName(workspaceName);
 
         // when not using persistent workspaces, we still want to create the first workspace on each monitor
@@ -475,8 +655,7 @@ static void mapMonitor(const PHLMONITOR& monitor) // NOLINT(readability-convert-
             Log::logger->log(Log::INFO, "[split-monitor-workspaces] Moving workspace {} to monitor {}", workspaceName, monitor->m_name);
             g_pCompositor->moveWorkspaceToMonitor(workspace, monitor);
             if (g_enablePersistentWorkspaces) {
-                workspace->setPersistent(true);
-                g_vPersistentWorkspaces.push_back(workspace); // keep a reference to avoid it being destructed (see https://github.com/hyprwm/Hyprland/discussions/11400#discussioncomment-14085672)
+                pinWorkspace(workspace);
             }
             else {
                 // if this is the first workspace on the monitor, we still want to make sure it's focused on startup
@@ -510,21 +689,13 @@ static void unmapMonitor(const PHLMONITOR& monitor)
             PHLWORKSPACE workspace = g_pCompositor->getWorkspaceByName(workspaceName);
 
             if (workspace.get() != nullptr) {
-                workspace->setPersistent(false);
-                // remove this workspace shared ptr from the persistent workspaces vector, so it can be destructed if no other references exist
-                std::erase(g_vPersistentWorkspaces, workspace);
+                unpinWorkspace(workspace);
             }
         }
         g_vMonitorWorkspaceMap.erase(monitor->m_id);
     }
 
-    if (g_vMonitorPriorities.contains(monitor->m_name) && !g_vMonitorPriorities[monitor->m_name].wasSetFromConfig) {
-        g_vMonitorPriorities.erase(monitor->m_name);
-    }
-
-    if (g_vMonitorMaxWorkspaces.contains(monitor->m_name) && !g_vMonitorMaxWorkspaces[monitor->m_name].wasSetFromConfig) {
-        g_vMonitorMaxWorkspaces.erase(monitor->m_name);
-    }
+    releaseMonitorConfig(g_vMonitorPriorities, g_vMonitorMaxWorkspaces, monitor->m_name);
 }
 
 static void unmapAllMonitors()
@@ -577,6 +748,73 @@ static void remapAllMonitors()
     }
 }
 
+static Trace::SMonitor traceMonitor(const PHLMONITOR& monitor)
+{
+    return {.id = monitor->m_id, .name = monitor->m_name, .skipped = monitor->m_activeMonitorRule.disabled || monitor->isMirror()};
+}
+
+static void recordEvent(Trace::SEvent event)
+{
+    if (!g_traceWriter.isOpen()) {
+        return;
+    }
+    event.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_traceStart).count();
+    g_traceWriter.write(event);
+}
+
+static void recordConfigReload()
+{
+    Trace::SEvent event{.type = Trace::eEventType::CONFIG_RELOAD};
+    event.config.workspaceCount = g_workspaceCount;
+    event.config.defaultMonitor = g_defaultMonitor;
+    event.config.flags = static_cast<uint8_t>((g_enablePersistentWorkspaces ? Trace::CONFIG_PERSISTENT : 0) | (g_enableWrapping ? Trace::CONFIG_WRAPPING : 0) |
+                                              (g_keepFocused ? Trace::CONFIG_KEEP_FOCUSED : 0) | (g_linkMonitors ? Trace::CONFIG_LINK_MONITORS : 0));
+    // only the values from the config, the others are derived again while remapping
+    for (const auto& [name, priority] : g_vMonitorPriorities) {
+        if (priority.wasSetFromConfig) {
+            event.config.priorities.emplace_back(name, priority.value);
+        }
+    }
+    for (const auto& [name, maxWorkspaces] : g_vMonitorMaxWorkspaces) {
+        if (maxWorkspaces.wasSetFromConfig) {
+            event.config.maxWorkspaces.emplace_back(name, maxWorkspaces.value);
+        }
+    }
+    for (const PHLMONITOR& monitor : g_pCompositor->m_monitors) {
+        event.config.monitors.push_back(traceMonitor(monitor));
+    }
+    recordEvent(std::move(event));
+}
+
+static void updateTraceFile(const std::string& path)
+{
+    if (path == g_traceFile) {
+        return;
+    }
+    g_traceFile = path;
+    g_traceWriter.close();
+    if (g_traceFile.empty()) {
+        return;
+    }
+    if (!g_traceWriter.open(g_traceFile)) {
+        Log::logger->log(Log::ERR, "[split-monitor-workspaces] Failed to open trace file {}", g_traceFile.c_str());
+        raiseNotification("[split-monitor-workspaces] Failed to open trace file " + g_traceFile);
+        g_traceWriter.close();
+        return;
+    }
+    g_traceStart = std::chrono::steady_clock::now();
+    Log::logger->log(Log::INFO, "[split-monitor-workspaces] Recording trace to {}", g_traceFile.c_str());
+}
+
+// registers a dispatcher that is recorded to the trace file (if enabled) before it runs
+static void addTracedDispatcher(const std::string& name, SDispatchResult (*dispatcher)(const std::string&))
+{
+    HyprlandAPI::addDispatcherV2(PHANDLE, name, [name, dispatcher](std::string arg) {
+        recordEvent({.type = Trace::eEventType::DISPATCH, .dispatcher = name, .argument = arg});
+        return dispatcher(arg);
+    });
+}
+
 static void loadConfigValues()
 {
     Log::logger->log(Log::INFO, "[split-monitor-workspaces] Loading config values");
@@ -587,6 +825,7 @@ static void loadConfigValues()
     g_enableWrapping = getConfigValue<Hyprlang::INT>(k_enableWrapping) != 0;
     g_defaultMonitor = getConfigValue<Hyprlang::STRING>(k_defaultMonitor);
     g_linkMonitors = getConfigValue<Hyprlang::INT>(k_linkMonitors) != 0;
+    updateTraceFile(getConfigValue<Hyprlang::STRING>(k_traceFile));
     Log::logger->log(Log::INFO,
                      "[split-monitor-workspaces] Config values loaded: workspaceCount={}, keepFocused={}, enableNotifications={}, enablePersistentWorkspaces={}, enableWrapping={}, "
                      "defaultMonitor='{}', linkMonitors={}",
@@ -597,6 +836,7 @@ static void reload()
 {
     Log::logger->log(Log::INFO, "[split-monitor-workspaces] Reloading plugin configuration");
     loadConfigValues();
+    recordConfigReload();
     remapAllMonitors();
     g_firstLoad = false;
 }
@@ -608,6 +848,7 @@ static void monitorAddedCallback(void* /*unused*/, SCallbackInfo& /*unused*/, st
         Log::logger->log(Log::WARN, "[split-monitor-workspaces] Monitor added callback called with nullptr?");
         return;
     }
+    recordEvent({.type = Trace::eEventType::MONITOR_ADDED, .monitor = traceMonitor(monitor)});
     mapMonitor(monitor);
 }
 
@@ -618,9 +859,52 @@ static void monitorRemovedCallback(void* /*unused*/, SCallbackInfo& /*unused*/,
         Log::logger->log(Log::WARN, "[split-monitor-workspaces] Monitor removed callback called with nullptr?");
         return;
     }
+    recordEvent({.type = Trace::eEventType::MONITOR_REMOVED, .monitor = traceMonitor(monitor)});
     unmapMonitor(monitor);
 }
 
+static void openWindowEarlyCallback(void* /*unused*/, SCallbackInfo& /*unused*/, std::any param) // NOLINT(performance-unnecessary-value-param)
+{
+    if (g_vWindowSlotRules.empty()) {
+        return;
+    }
+    auto window = std::any_cast<PHLWINDOW>(param);
+    if (window == nullptr) {
+        Log::logger->log(Log::WARN, "[split-monitor-workspaces] Open window early callback called with nullptr?");
+        return;
+    }
+
+    auto const rule = std::ranges::find_if(
+        g_vWindowSlotRules, [&window](const WindowSlotRule& r) { return std::regex_search(r.matchTitle ? window->m_initialTitle : window->m_initialClass, r.matcher); });
+    if (rule == g_vWindowSlotRules.end()) {
+        return;
+    }
+
+    PHLMONITOR monitor = rule->monitorName.empty() ? window->m_monitor.lock() : g_pCompositor->getMonitorFromName(rule->monitorName);
+    if (monitor == nullptr) {
+        Log::logger->log(Log::INFO, "[split-monitor-workspaces] Monitor '{}' for window {} is not connected, leaving it where it is", rule->monitorName.c_str(), window->m_initialClass.c_str());
+        return;
+    }
+
+    // this event fires before Hyprland applies its own window rules and lays out the window, so setting the workspace here
+    // places it directly. Hyprland's own workspace rules still win over ours.
+    // the window is already mapped on its initial workspace, it must not make that workspace count as occupied for "empty"
+    std::string error;
+    const PHLWORKSPACE workspace = getOrCreateMappedWorkspace(monitor, rule->slot, error, window);
+    if (workspace == nullptr) {
+        // e.g. the monitor is disabled or mirrored, falling back to a global workspace could put the window on another monitor
+        Log::logger->log(Log::INFO, "[split-monitor-workspaces] Cannot resolve the slot for window {} on monitor {} ({}), leaving it where it is", window->m_initialClass.c_str(),
+                         monitor->m_name.c_str(), error.c_str());
+        return;
+    }
+    if (workspace == window->m_workspace) {
+        return;
+    }
+    Log::logger->log(Log::INFO, "[split-monitor-workspaces] Opening window {} on workspace {}", window->m_initialClass.c_str(), workspace->m_name.c_str());
+    window->m_workspace = workspace;
+    window->m_monitor = workspace->m_monitor;
+}
+
 static void configReloadedCallback(void* /*unused*/, SCallbackInfo& /*unused*/, std::any /*unused*/) // NOLINT(performance-unnecessary-value-param)
 {
     // !!! anything you call in this function should not reload the config, as it will cause an infinite loop !!!
@@ -636,6 +920,7 @@ static void preConfigReloadCallback(void* /*unused*/, SCallbackInfo& /*unused*/,
     // the config. Without this, the old values would persist.
     g_vMonitorPriorities.clear();
     g_vMonitorMaxWorkspaces.clear();
+    g_vWindowSlotRules.clear();
 }
 
 static Hyprlang::CParseResult monitorPriorityConfigHandler(const char* command, const char* args)
@@ -686,6 +971,70 @@ static Hyprlang::CParseResult monitorMaxWorkspacesConfigHandler(const char* comm
     return result;
 }
 
+static Hyprlang::CParseResult windowSlotConfigHandler(const char* command, const char* args)
+{
+    // the matcher is the last argument, so regexes may contain commas
+    const auto ARGS = CVarList(args, 2);
+
+    if (ARGS.size() != 2) {
+        Hyprlang::CParseResult result;
+        std::string errorMsg = "[split-monitor-workspaces] Invalid number of arguments, expected 2 (target, matcher)";
+        Log::logger->log(Log::ERR, errorMsg);
+        result.setError(errorMsg.c_str());
+        return result;
+    }
+
+    std::string parseError;
+
+    try {
+        // target: "slot" on the monitor the window opens on, or "MONITOR:slot"
+        WindowSlotRule rule;
+        const std::string target = ARGS[0];
+        std::string slot = target;
+        if (auto const separator = target.find(':'); separator != std::string::npos) {
+            rule.monitorName = target.substr(0, separator);
+            slot = target.substr(separator + 1);
+        }
+
+        // matcher: "class:regex", "title:regex" or just "regex" for the class
+        std::string matcher = ARGS[1];
+        if (matcher.starts_with("title:")) {
+            rule.matchTitle = true;
+            matcher = matcher.substr(6);
+        }
+        else if (matcher.starts_with("class:")) {
+            matcher = matcher.substr(6);
+        }
+        rule.matcher = std::regex(matcher);
+
+        // parse the slot once here instead of for every window that opens
+        std::string slotError;
+        if (slot.empty()) {
+            parseError = "[split-monitor-workspaces] Missing slot in window_slot target " + target;
+        }
+        else if (!parseWorkspaceSlot(slot, rule.slot, slotError)) {
+            parseError = "[split-monitor-workspaces] Invalid slot in window_slot target " + target + ": " + slotError;
+        }
+        else {
+            Log::logger->log(Log::INFO, "[split-monitor-workspaces] Adding window slot rule: {} {} -> {}", rule.matchTitle ? "title" : "class", matcher.c_str(), target.c_str());
+            g_vWindowSlotRules.push_back(std::move(rule));
+        }
+    }
+    catch (const std::regex_error& e) {
+        parseError = std::string{"[split-monitor-workspaces] Invalid window_slot regex: "} + e.what();
+    }
+    catch (const std::out_of_range&) {
+        parseError = "[split-monitor-workspaces] Slot out of range in window_slot target " + std::string{ARGS[0]};
+    }
+
+    Hyprlang::CParseResult result;
+    if (!parseError.empty()) {
+        Log::logger->log(Log::ERR, parseError);
+        result.setError(parseError.c_str());
+    }
+    return result;
+}
+
 // Do NOT change this function.
 APICALL EXPORT std::string PLUGIN_API_VERSION()
 {
@@ -704,21 +1053,28 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle)
     HyprlandAPI::addConfigValue(PHANDLE, k_defaultMonitor, Hyprlang::STRING{""});
     HyprlandAPI::addConfigKeyword(PHANDLE, k_monitorPriority, monitorPriorityConfigHandler, (Hyprlang::SHandlerOptions){.allowFlags = false});
     HyprlandAPI::addConfigKeyword(PHANDLE, k_monitorMaxWorkspaces, monitorMaxWorkspacesConfigHandler, (Hyprlang::SHandlerOptions){.allowFlags = false});
+    HyprlandAPI::addConfigKeyword(PHANDLE, k_windowSlot, windowSlotConfigHandler, (Hyprlang::SHandlerOptions){.allowFlags = false});
     HyprlandAPI::addConfigValue(PHANDLE, k_linkMonitors, Hyprlang::INT{0});
-
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-workspace", splitWorkspace);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-cycleworkspaces", splitCycleWorkspaces);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-cycleworkspacesnowrap", splitCycleWorkspacesNowrap);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-movetoworkspace", splitMoveToWorkspace);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-movetoworkspacesilent", splitMoveToWorkspaceSilent);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-changemonitor", splitChangeMonitor);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-changemonitorsilent", splitChangeMonitorSilent);
-    HyprlandAPI::addDispatcherV2(PHANDLE, "split-grabroguewindows", grabRogueWindows);
+    HyprlandAPI::addConfigValue(PHANDLE, k_traceFile, Hyprlang::STRING{""});
+
+    addTracedDispatcher("split-workspace", splitWorkspace);
+    addTracedDispatcher("split-cycleworkspaces", splitCycleWorkspaces);
+    addTracedDispatcher("split-cycleworkspacesnowrap", splitCycleWorkspacesNowrap);
+    addTracedDispatcher("split-movetoworkspace", splitMoveToWorkspace);
+    addTracedDispatcher("split-movetoworkspacesilent", splitMoveToWorkspaceSilent);
+    addTracedDispatcher("split-moveworkspacewindows", splitMoveWorkspaceWindows);
+    addTracedDispatcher("split-moveslotwindows", splitMoveSlotWindows);
+    addTracedDispatcher("split-changemonitor", splitChangeMonitor);
+    addTracedDispatcher("split-changemonitorsilent", splitChangeMonitorSilent);
+    addTracedDispatcher("split-grabroguewindows", grabRogueWindows);
 
     e_monitorAddedHandle = HyprlandAPI::registerCallbackDynamic(PHANDLE, "monitorAdded", monitorAddedCallback);
     e_monitorRemovedHandle = HyprlandAPI::registerCallbackDynamic(PHANDLE, "monitorRemoved", monitorRemovedCallback);
     e_configReloadedHandle = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded", configReloadedCallback);
     e_preConfigReloadHandle = HyprlandAPI::registerCallbackDynamic(PHANDLE, "preConfigReload", preConfigReloadCallback);
+    e_openWindowEarlyHandle = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindowEarly", openWindowEarlyCallback);
+
+    e_pinnedCommandHandle = HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "split-pinned", .exact = true, .fn = pinnedWorkspacesCommand});
 
     // config loading and initial mapping of the workspaces will happen after plugin initialization, through the configReloadedCallback.
     // this is because Hyprland will automatically force a config reload after the plugin is loaded
@@ -729,6 +1085,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle)
 
 APICALL EXPORT void PLUGIN_EXIT()
 {
+    HyprlandAPI::unregisterHyprCtlCommand(PHANDLE, e_pinnedCommandHandle);
     unmapAllMonitors();
+    g_traceWriter.close();
     raiseNotification("[split-monitor-workspaces] Unloaded successfully!");
 }
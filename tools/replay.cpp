@@ -0,0 +1,505 @@
+// Replays a trace recorded with `plugin:split-monitor-workspaces:trace_file` against a headless stub compositor.
+// The stub uses the same workspace mapping as mapMonitor/unmapMonitor (see include/mapping.hpp), and reports how long each
+// event took to process and the resulting workspace layout, so a user's dock/undock sequence can be rerun as a regression test.
+//
+// usage: split-monitor-workspaces-replay <trace file> [-q] [--write-layout <file>] [--expect-layout <file>] [--max-p99 <us>]
+//   -q:                     only print the summary and the final layout
+//   --write-layout <file>:  store the final layout, to be used with --expect-layout later
+//   --expect-layout <file>: fail if the final layout differs from the stored one
+//   --max-p99 <us>:         fail if the p99 latency of any event type exceeds this budget
+//
+// exit codes: 0 ok, 1 usage or trace error, 2 regression (layout mismatch, latency over budget, or an event threw like it would in the plugin)
+
+#include "mapping.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SStubMonitor {
+    int64_t id = 0;
+    std::string name;
+    bool skipped = false;
+    std::string activeWorkspace;
+};
+
+struct SStubWorkspace {
+    int64_t monitorID = -1;
+    bool persistent = false;
+};
+
+// a headless stand-in for the parts of Hyprland the plugin touches: monitors, workspaces and which workspace is active where
+class CStubCompositor {
+  public:
+    void configReload(const Trace::SConfig& config)
+    {
+        // preConfigReloadCallback, then the config handlers
+        m_priorities.clear();
+        m_maxWorkspaces.clear();
+        for (const auto& [name, value] : config.priorities) {
+            m_priorities[name] = {.value = value, .wasSetFromConfig = true};
+        }
+        for (const auto& [name, value] : config.maxWorkspaces) {
+            m_maxWorkspaces[name] = {.value = value, .wasSetFromConfig = true};
+        }
+        m_config = config;
+
+        // the trace also tells us which monitors exist at this point, which matters for traces that start mid-session
+        m_monitors.clear();
+        for (const auto& monitor : config.monitors) {
+            m_monitors.push_back({.id = monitor.id, .name = monitor.name, .skipped = monitor.skipped, .activeWorkspace = {}});
+        }
+
+        remapAllMonitors();
+        m_firstLoad = false;
+    }
+
+    void monitorAdded(const Trace::SMonitor& monitor)
+    {
+        if (findMonitor(monitor.id) == nullptr) {
+            m_monitors.push_back({.id = monitor.id, .name = monitor.name, .skipped = monitor.skipped, .activeWorkspace = {}});
+        }
+        mapMonitor(*findMonitor(monitor.id));
+    }
+
+    void monitorRemoved(const Trace::SMonitor& monitor)
+    {
+        if (SStubMonitor* stubMonitor = findMonitor(monitor.id)) {
+            unmapMonitor(*stubMonitor);
+        }
+        std::erase_if(m_monitors, [&monitor](const SStubMonitor& m) { return m.id == monitor.id; });
+        if (m_focusedMonitor == monitor.id) {
+            // Hyprland moves focus to another monitor
+            m_focusedMonitor = m_monitors.empty() ? -1 : m_monitors.front().id;
+        }
+        collectWorkspaces();
+    }
+
+    // returns false for dispatchers that only act on windows, which the stub doesn't have
+    bool dispatch(const std::string& dispatcher, const std::string& argument)
+    {
+        SStubMonitor* monitor = findMonitor(m_focusedMonitor);
+        if (monitor == nullptr) {
+            return false;
+        }
+
+        // unlinked split-movetoworkspace only moves the focused window, linked it also switches the workspace on all monitors
+        if (dispatcher == "split-workspace" || (dispatcher == "split-movetoworkspace" && linkMonitors())) {
+            if (!linkMonitors()) {
+                changeWorkspace(*monitor, resolveWorkspace(*monitor, argument));
+                return true;
+            }
+            for (auto& m : m_monitors) {
+                changeWorkspace(m, resolveWorkspace(m, argument));
+            }
+            m_focusedMonitor = monitor->id; // only the current monitor keeps focus
+            return true;
+        }
+
+        if (dispatcher == "split-cycleworkspaces" || dispatcher == "split-cycleworkspacesnowrap") {
+            bool const nowrap = dispatcher == "split-cycleworkspacesnowrap" || !wrapping();
+            if (!linkMonitors()) {
+                cycleWorkspace(*monitor, argument, nowrap);
+                return true;
+            }
+            for (auto& m : m_monitors) {
+                if (!cycleWorkspace(m, argument, nowrap)) {
+                    break;
+                }
+            }
+            m_focusedMonitor = monitor->id;
+            return true;
+        }
+
+        return false;
+    }
+
+    // one line per monitor plus a workspace count, stable so it can be stored and compared with --expect-layout
+    std::string formatLayout() const
+    {
+        std::ostringstream layout;
+        for (const auto& monitor : m_monitors) {
+            layout << "  " << monitor.name << " (ID " << monitor.id << "): ";
+            auto const it = m_monitorWorkspaceMap.find(monitor.id);
+            if (it == m_monitorWorkspaceMap.end() || it->second.empty()) {
+                layout << "not mapped" << (monitor.skipped ? " (disabled or mirrored)" : "") << "\n";
+                continue;
+            }
+            layout << "workspaces " << it->second.front() << "-" << it->second.back() << ", active " << (monitor.activeWorkspace.empty() ? "-" : monitor.activeWorkspace)
+                   << (monitor.id == m_focusedMonitor ? " (focused)" : "") << "\n";
+        }
+        size_t persistent = 0;
+        for (const auto& [name, workspace] : m_workspaces) {
+            persistent += workspace.persistent ? 1 : 0;
+        }
+        layout << "  " << m_workspaces.size() << " workspaces, " << persistent << " persistent\n";
+        return layout.str();
+    }
+
+  private:
+    bool persistentWorkspaces() const
+    {
+        return (m_config.flags & Trace::CONFIG_PERSISTENT) != 0;
+    }
+
+    bool wrapping() const
+    {
+        return (m_config.flags & Trace::CONFIG_WRAPPING) != 0;
+    }
+
+    bool keepFocused() const
+    {
+        return (m_config.flags & Trace::CONFIG_KEEP_FOCUSED) != 0;
+    }
+
+    bool linkMonitors() const
+    {
+        return (m_config.flags & Trace::CONFIG_LINK_MONITORS) != 0;
+    }
+
+    SStubMonitor* findMonitor(int64_t id)
+    {
+        auto const it = std::ranges::find(m_monitors, id, &SStubMonitor::id);
+        return it != m_monitors.end() ? &*it : nullptr;
+    }
+
+    void changeWorkspace(SStubMonitor& monitor, const std::string& workspaceName)
+    {
+        auto& workspace = m_workspaces[workspaceName];
+        workspace.monitorID = monitor.id;
+        monitor.activeWorkspace = workspaceName;
+        m_focusedMonitor = monitor.id;
+        collectWorkspaces();
+    }
+
+    // Hyprland destroys workspaces that are neither persistent, active nor hold windows. The stub has no windows.
+    void collectWorkspaces()
+    {
+        std::erase_if(m_workspaces, [this](const auto& entry) {
+            return !entry.second.persistent && std::ranges::none_of(m_monitors, [&entry](const SStubMonitor& m) { return m.activeWorkspace == entry.first; });
+        });
+    }
+
+    // getWorkspaceFromMonitor: the shared slot resolution, every workspace counts as empty since the stub has no windows
+    std::string resolveWorkspace(const SStubMonitor& monitor, const std::string& workspace) const
+    {
+        auto const it = m_monitorWorkspaceMap.find(monitor.id);
+        if (it == m_monitorWorkspaceMap.end()) {
+            return workspace;
+        }
+        std::string error;
+        return resolveWorkspaceSlot(it->second, monitor.activeWorkspace, workspace, wrapping(), [](const std::string&) { return true; }, error);
+    }
+
+    // cycleWorkspaces: unlike slot resolution, going past either end without wrapping is a no-op. Returns false when it stopped.
+    bool cycleWorkspace(SStubMonitor& monitor, const std::string& value, bool nowrap)
+    {
+        int delta = 0;
+        if (value == "next" || value == "prev") {
+            delta = value == "next" ? 1 : -1;
+        }
+        else {
+            try {
+                delta = std::stoi(value);
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+        auto const it = m_monitorWorkspaceMap.find(monitor.id);
+        if (delta == 0 || it == m_monitorWorkspaceMap.end()) {
+            return false;
+        }
+        const std::vector<std::string>& workspaces = it->second;
+        auto const current = std::ranges::find(workspaces, monitor.activeWorkspace);
+        if (current == workspaces.end()) {
+            return false;
+        }
+
+        int64_t index = std::distance(workspaces.begin(), current) + delta;
+        if (index < 0) {
+            if (nowrap) {
+                return false;
+            }
+            index = static_cast<int64_t>(workspaces.size()) - 1;
+        }
+        else if (static_cast<size_t>(index) >= workspaces.size()) {
+            if (nowrap) {
+                return false;
+            }
+            index = 0;
+        }
+        changeWorkspace(monitor, workspaces[index]);
+        return true;
+    }
+
+    void mapMonitor(SStubMonitor& monitor)
+    {
+        if (monitor.skipped) {
+            return;
+        }
+        ensureMonitorPriority(m_priorities, monitor.name);
+
+        // like the plugin, release the previous range of a monitor that is mapped again
+        if (auto const previousIt = m_monitorWorkspaceMap.find(monitor.id); previousIt != m_monitorWorkspaceMap.end()) {
+            for (const auto& workspaceName : previousIt->second) {
+                if (auto workspace = m_workspaces.find(workspaceName); workspace != m_workspaces.end()) {
+                    workspace->second.persistent = false;
+                }
+            }
+        }
+
+        const std::vector<std::string>& workspaceNames = m_monitorWorkspaceMap[monitor.id] =
+            getMonitorWorkspaceNames(m_priorities, m_maxWorkspaces, m_config.workspaceCount, monitor.name);
+
+        for (size_t i = 0; i < workspaceNames.size(); i++) {
+            auto it = m_workspaces.find(workspaceNames[i]);
+            if (it == m_workspaces.end() && (persistentWorkspaces() || i == 0)) {
+                it = m_workspaces.emplace(workspaceNames[i], SStubWorkspace{}).first;
+            }
+            if (it != m_workspaces.end()) {
+                it->second.monitorID = monitor.id;
+                it->second.persistent = persistentWorkspaces();
+            }
+        }
+
+        if ((!keepFocused() || m_firstLoad) && !workspaceNames.empty()) {
+            changeWorkspace(monitor, workspaceNames.front());
+        }
+    }
+
+    void unmapMonitor(const SStubMonitor& monitor)
+    {
+        auto const it = m_monitorWorkspaceMap.find(monitor.id);
+        if (it != m_monitorWorkspaceMap.end()) {
+            for (const auto& workspaceName : it->second) {
+                if (auto workspace = m_workspaces.find(workspaceName); workspace != m_workspaces.end()) {
+                    workspace->second.persistent = false;
+                }
+            }
+            m_monitorWorkspaceMap.erase(it);
+        }
+        releaseMonitorConfig(m_priorities, m_maxWorkspaces, monitor.name);
+    }
+
+    void remapAllMonitors()
+    {
+        for (const auto& monitor : m_monitors) {
+            unmapMonitor(monitor);
+        }
+        m_monitorWorkspaceMap.clear();
+        for (auto& monitor : m_monitors) {
+            mapMonitor(monitor);
+        }
+        if (!keepFocused() || m_firstLoad) {
+            // getPrimaryMonitor: the default monitor from the config if it exists, otherwise the one with the lowest ID
+            auto primary = std::ranges::find(m_monitors, m_config.defaultMonitor, &SStubMonitor::name);
+            if (m_config.defaultMonitor.empty() || primary == m_monitors.end()) {
+                primary = std::ranges::min_element(m_monitors, std::ranges::less{}, &SStubMonitor::id);
+            }
+            // a monitor with max_workspaces = 0 is mapped to no workspaces at all
+            if (primary != m_monitors.end() && m_monitorWorkspaceMap.contains(primary->id) && !m_monitorWorkspaceMap[primary->id].empty()) {
+                changeWorkspace(*primary, m_monitorWorkspaceMap[primary->id].front());
+            }
+        }
+        collectWorkspaces();
+    }
+
+    Trace::SConfig m_config;
+    MonitorConfigMap m_priorities;
+    MonitorConfigMap m_maxWorkspaces;
+    std::vector<SStubMonitor> m_monitors;
+    std::map<std::string, SStubWorkspace> m_workspaces;
+    std::map<int64_t, std::vector<std::string>> m_monitorWorkspaceMap;
+    int64_t m_focusedMonitor = -1;
+    bool m_firstLoad = true;
+};
+
+struct SLatencyStats {
+    std::vector<double> samplesUs;
+
+    // nearest-rank percentile, expects sorted samples
+    double percentile(double p) const
+    {
+        auto const rank = static_cast<size_t>(std::ceil(p * static_cast<double>(samplesUs.size())));
+        return samplesUs[rank > 0 ? rank - 1 : 0];
+    }
+
+    void print(const char* name)
+    {
+        if (samplesUs.empty()) {
+            return;
+        }
+        std::ranges::sort(samplesUs);
+        double total = 0;
+        for (double sample : samplesUs) {
+            total += sample;
+        }
+        std::printf("  %-28s %6zu events  mean %9.2fus  p50 %9.2fus  p99 %9.2fus  max %9.2fus\n", name, samplesUs.size(), total / static_cast<double>(samplesUs.size()), percentile(0.5),
+                    percentile(0.99), samplesUs.back());
+    }
+};
+
+const char* eventTypeName(Trace::eEventType type)
+{
+    switch (type) {
+        case Trace::eEventType::DISPATCH: return "dispatch";
+        case Trace::eEventType::MONITOR_ADDED: return "monitorAdded";
+        case Trace::eEventType::MONITOR_REMOVED: return "monitorRemoved";
+        case Trace::eEventType::CONFIG_RELOAD: return "configReload";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+static int usage(const char* name)
+{
+    std::fprintf(stderr, "usage: %s <trace file> [-q] [--write-layout <file>] [--expect-layout <file>] [--max-p99 <us>]\n", name);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        return usage(argv[0]);
+    }
+
+    bool quiet = false;
+    std::string writeLayoutPath;
+    std::string expectLayoutPath;
+    double maxP99Us = 0;
+    for (int i = 2; i < argc; i++) {
+        std::string const arg = argv[i];
+        if (arg == "-q") {
+            quiet = true;
+        }
+        else if (arg == "--write-layout" && i + 1 < argc) {
+            writeLayoutPath = argv[++i];
+        }
+        else if (arg == "--expect-layout" && i + 1 < argc) {
+            expectLayoutPath = argv[++i];
+        }
+        else if (arg == "--max-p99" && i + 1 < argc) {
+            try {
+                maxP99Us = std::stod(argv[++i]);
+            }
+            catch (const std::exception&) {
+                return usage(argv[0]);
+            }
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+
+    Trace::CReader reader;
+    if (!reader.open(argv[1])) {
+        std::fprintf(stderr, "%s: not a split-monitor-workspaces trace (version %u)\n", argv[1], static_cast<unsigned>(Trace::VERSION));
+        return 1;
+    }
+
+    CStubCompositor compositor;
+    std::map<std::string, SLatencyStats> stats;
+    Trace::SEvent event;
+    size_t index = 0;
+    size_t failures = 0;
+    while (reader.next(event)) {
+        std::string description;
+        std::string statsKey = eventTypeName(event.type);
+        bool handled = true;
+        std::string exception;
+
+        auto const start = std::chrono::steady_clock::now();
+        try {
+            switch (event.type) {
+                case Trace::eEventType::DISPATCH:
+                    description = event.dispatcher + " " + event.argument;
+                    statsKey = event.dispatcher;
+                    handled = compositor.dispatch(event.dispatcher, event.argument);
+                    break;
+                case Trace::eEventType::MONITOR_ADDED:
+                    description = event.monitor.name;
+                    compositor.monitorAdded(event.monitor);
+                    break;
+                case Trace::eEventType::MONITOR_REMOVED:
+                    description = event.monitor.name;
+                    compositor.monitorRemoved(event.monitor);
+                    break;
+                case Trace::eEventType::CONFIG_RELOAD:
+                    description = std::to_string(event.config.monitors.size()) + " monitors, count " + std::to_string(event.config.workspaceCount);
+                    compositor.configReload(event.config);
+                    break;
+            }
+        }
+        catch (const std::exception& e) {
+            // the plugin doesn't catch these either, so this is a failure in production too
+            exception = e.what();
+            failures++;
+        }
+        auto const latencyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        stats[statsKey].samplesUs.push_back(latencyUs);
+
+        if (!exception.empty()) {
+            std::printf("%6zu %12.3fms %-15s %-40s threw: %s\n", index, static_cast<double>(event.timestampNs) / 1e6, eventTypeName(event.type), description.c_str(), exception.c_str());
+        }
+        else if (!quiet) {
+            std::printf("%6zu %12.3fms %-15s %-40s %9.2fus%s\n", index, static_cast<double>(event.timestampNs) / 1e6, eventTypeName(event.type), description.c_str(), latencyUs,
+                        handled ? "" : " (no windows in stub, not applied)");
+        }
+        index++;
+    }
+    if (reader.failed()) {
+        // a damaged trace must not pass as a regression test
+        std::fprintf(stderr, "%s: event %zu is truncated or of an unknown type\n", argv[1], index);
+        return 1;
+    }
+
+    std::printf("\n%zu events replayed\n", index);
+    bool regression = failures > 0;
+    if (failures > 0) {
+        std::printf("%zu events threw\n", failures);
+    }
+    for (auto& [name, stat] : stats) {
+        stat.print(name.c_str());
+        if (maxP99Us > 0 && stat.percentile(0.99) > maxP99Us) {
+            std::printf("  %s: p99 %.2fus exceeds the budget of %.2fus\n", name.c_str(), stat.percentile(0.99), maxP99Us);
+            regression = true;
+        }
+    }
+
+    std::string const layout = compositor.formatLayout();
+    std::printf("\nfinal layout:\n%s", layout.c_str());
+
+    if (!writeLayoutPath.empty()) {
+        std::ofstream file(writeLayoutPath, std::ios::trunc);
+        file << layout;
+        if (!file.good()) {
+            std::fprintf(stderr, "%s: failed to write layout\n", writeLayoutPath.c_str());
+            return 1;
+        }
+    }
+    if (!expectLayoutPath.empty()) {
+        std::ifstream file(expectLayoutPath);
+        if (!file.good()) {
+            std::fprintf(stderr, "%s: failed to read expected layout\n", expectLayoutPath.c_str());
+            return 1;
+        }
+        std::string const expected{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        if (expected != layout) {
+            std::printf("\nlayout differs from %s, expected:\n%s", expectLayoutPath.c_str(), expected.c_str());
+            regression = true;
+        }
+    }
+    return regression ? 2 : 0;
+}